@@ -24,6 +24,8 @@
 // C++标准库包含
 #include <random>           // C++11随机数库
 
+class PlotWidget;           // 函数绘图控件
+
 /**
  * @class CalculatorWindow
  * @brief 计算器应用程序的主窗口类
@@ -33,6 +35,7 @@
  * 2. 维护表达式显示和按钮状态
  * 3. 处理按钮点击和表达式求值
  * 4. 提供基本的数学运算（加减乘除）和括号支持
+ * 5. 绘制含变量x的表达式曲线
  * 
  * 继承自QMainWindow，使用Qt的信号槽机制处理事件。
  */
@@ -64,6 +67,11 @@ private slots:
      */
     void onDecimalClicked();
 
+    /**
+     * @brief 处理变量x按钮点击的槽函数
+     */
+    void onVariableClicked();
+
     /**
      * @brief 处理操作符按钮点击的槽函数
      * @param op 点击的操作符字符
@@ -86,6 +94,11 @@ private slots:
      */
     void evaluateExpression();
 
+    /**
+     * @brief 绘制当前表达式的函数曲线
+     */
+    void plotExpression();
+
 private:
     /**
      * @brief 设置用户界面
@@ -106,6 +119,9 @@ private:
     QPushButton *clearButton;      ///< 清除按钮
     QPushButton *equalsButton;     ///< 等号按钮
     QPushButton *decimalButton;    ///< 小数点按钮
+    QPushButton *variableButton;   ///< 变量x按钮
+    QPushButton *plotButton;       ///< 绘图按钮
+    PlotWidget *plotWidget;        ///< 函数绘图区域
 };
 
 #endif // CALCULATORWINDOW_H
\ No newline at end of file
@@ -4,6 +4,7 @@
  * 
  * 该文件定义了ExpressionEvaluator类，用于解析和求值数学表达式。
  * 支持加减乘除和括号运算，遵循运算符优先级。
+ * 另提供CompiledExpression，将含变量x的表达式编译一次后批量求值（用于函数绘图）。
  */
 
 #pragma once
@@ -13,6 +14,71 @@
 #include <vector>
 #include <cctype>
 #include <stdexcept>
+#include <cstddef>
+
+/**
+ * @class CompiledExpression
+ * @brief 已编译的单变量（x）表达式
+ *
+ * 由ExpressionEvaluator::compile()生成，内部保存后缀指令序列。
+ * 编译阶段完成全部语法检查，求值阶段不再解析字符串，
+ * 适合对同一表达式在大量采样点上反复求值。
+ *
+ * 与ExpressionEvaluator::evaluate()不同，除零不抛出异常，
+ * 而是返回NaN，表示该点无定义（绘图时断开曲线）。
+ */
+class CompiledExpression {
+public:
+    /**
+     * @brief 在单个点上求值
+     *
+     * 逐条解释指令的标量路径，不经过批量内核；适合少量求值，
+     * 大量采样应使用evaluateBatch()。
+     *
+     * @param x 变量x的取值
+     * @return 计算结果；除零时返回NaN
+     */
+    double evaluate(double x) const;
+
+    /**
+     * @brief 批量求值内核
+     *
+     * 按固定大小的块逐条执行指令，每条指令在整块数据上运行一个紧凑循环，
+     * 避免逐点解释指令的分派开销，便于编译器向量化。
+     *
+     * @param xs 输入的x数组
+     * @param out 输出数组（可与xs为同一数组）
+     * @param count 元素个数
+     */
+    void evaluateBatch(const double* xs, double* out, std::size_t count) const;
+
+    /**
+     * @brief 表达式是否引用了变量x
+     * @return 引用了x返回true
+     */
+    bool dependsOnVariable() const { return usesVariable; }
+
+private:
+    friend class ExpressionEvaluator;
+
+    /**
+     * @brief 只能由ExpressionEvaluator::compile()创建，保证指令序列非空且合法
+     */
+    CompiledExpression() = default;
+
+    /**
+     * @brief 后缀指令
+     */
+    struct Instruction {
+        enum Op { PushConstant, PushVariable, Add, Subtract, Multiply, Divide };
+        Op op;
+        double value; ///< 仅PushConstant使用
+    };
+
+    std::vector<Instruction> program; ///< 后缀指令序列
+    std::size_t maxDepth = 0;         ///< 求值栈最大深度
+    bool usesVariable = false;        ///< 是否引用变量x
+};
 
 /**
  * @class ExpressionEvaluator
@@ -36,6 +102,14 @@ public:
      */
     static double evaluate(const std::string& expression);
 
+    /**
+     * @brief 编译含变量x的数学表达式
+     * @param expression 数学表达式字符串，可使用变量x
+     * @return 已编译表达式，可反复求值
+     * @throws std::invalid_argument 如果表达式无效
+     */
+    static CompiledExpression compile(const std::string& expression);
+
 private:
     /**
      * @brief 获取运算符优先级
@@ -64,7 +138,9 @@ private:
     /**
      * @brief 将中缀表达式转换为后缀表达式（逆波兰表示法）
      * @param expression 中缀表达式
+     * @param allowVariable 是否允许变量x
      * @return 后缀表达式标记向量
      */
-    static std::vector<std::string> infixToPostfix(const std::string& expression);
+    static std::vector<std::string> infixToPostfix(const std::string& expression,
+                                                   bool allowVariable = false);
 };
\ No newline at end of file
@@ -0,0 +1,182 @@
+/**
+ * @file functionsampler.h
+ * @brief 单变量函数的分块自适应采样器
+ *
+ * 该文件定义了FunctionSampler类，负责函数绘图的采样缓存、自适应细化和抽稀，
+ * 不依赖Qt，可脱离窗口单独测试。PlotWidget只负责视口、时间片和绘制。
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "evaluator.h"
+
+/**
+ * @class FunctionSampler
+ * @brief 分块自适应采样器
+ *
+ * 采样策略：
+ * 1. x轴按2的幂划分为分块（tile），分块 (level, index) 覆盖
+ *    [index*2^level, (index+1)*2^level]
+ * 2. 新分块先做粗采样，所有新分块的采样点汇总为一次批量求值
+ * 3. 细化时收集待细化区间的中点批量求值，中点偏离线性插值超过容差的区间继续细化
+ * 4. 缺失分块优先由两个子分块拼接或从父分块截取，而不是重新采样
+ * 5. 绘制用的点按列做最小/最大值抽稀，无定义处以NaN断开
+ */
+class FunctionSampler {
+public:
+    /// 分块键：（层级，序号）
+    using TileKey = std::pair<int, long long>;
+
+    /**
+     * @brief 数据坐标中的点
+     */
+    struct Point {
+        double x;
+        double y;
+    };
+
+    /**
+     * @brief 一个分块的采样结果
+     */
+    struct Tile {
+        std::vector<double> xs;       ///< 采样点x（升序，包含两端点）
+        std::vector<double> ys;       ///< 采样点y，无定义处为NaN
+        std::vector<char> active;     ///< active[i]表示区间[i, i+1]仍需细化
+        std::vector<Point> decimated; ///< 抽稀后的绘制点
+        double tolerance = 0.0;       ///< 细化容差（y数据单位）
+        int passes = 0;               ///< 已完成的细化轮数
+        bool converged = false;       ///< 是否已无需细化
+        bool decimatedDirty = true;   ///< 抽稀结果是否需要重算
+        std::uint64_t lastUsed = 0;   ///< 最近一次可见的帧序号，用于淘汰
+    };
+
+    static constexpr int kMinLevel = -40;  ///< 最细层级
+    static constexpr int kMaxLevel = 40;   ///< 最粗层级
+
+    static constexpr double kMinSpan = 1e-6;       ///< 可见区域最小跨度
+    static constexpr double kMaxSpan = 1e9;        ///< 可见区域最大跨度，保证可见分块数有界
+    static constexpr double kMaxCoordinate = 1e9;  ///< 可见区域中心的最大绝对值
+
+    /**
+     * @brief 构造函数
+     * @param expression 已编译的表达式
+     */
+    explicit FunctionSampler(const CompiledExpression& expression);
+
+    /**
+     * @brief 分块宽度（数据单位）
+     */
+    static double tileWidth(int level);
+
+    /**
+     * @brief 父分块序号（向负无穷取整的除以2）
+     */
+    static long long parentIndex(long long index);
+
+    /**
+     * @brief 选择分块层级，使每个分块约占64~128像素
+     * @param unitsPerPixel 每像素对应的x数据单位
+     */
+    static int levelFor(double unitsPerPixel);
+
+    /**
+     * @brief 把可见区域的一个坐标范围限制在允许的跨度和位置内
+     *
+     * 跨度以中心为准夹紧到 [kMinSpan, kMaxSpan]，中心夹紧到 ±kMaxCoordinate。
+     * @return 范围含无穷大/NaN或不是递增区间时返回false，此时不修改参数
+     */
+    static bool clampViewRange(double& lo, double& hi);
+
+    /**
+     * @brief 覆盖 [xMin, xMax] 的分块键（从左到右）
+     *
+     * 范围非有限或分块序号超出long long时返回空。
+     */
+    static std::vector<TileKey> tilesInRange(int level, double xMin, double xMax);
+
+    /**
+     * @brief 已编译的表达式
+     */
+    const CompiledExpression& expression() const { return function; }
+
+    /**
+     * @brief 设置采样分辨率
+     * @param pixelTolerance 细化容差（y数据单位，通常为半个像素）
+     * @param viewHeight 可见区域的y跨度，跨越它且异号的区间视为极点
+     */
+    void setResolution(double pixelTolerance, double viewHeight);
+
+    /**
+     * @brief 开始新的一帧并为缺失的分块生成初始采样
+     *
+     * 传入的分块视为当前可见，淘汰时不会被移除。
+     * 容差比已有分块更小（如在同一层级内放大）时，重新激活需要细化的区间。
+     */
+    void ensureTiles(const std::vector<TileKey>& keys);
+
+    /**
+     * @brief 对分块做一轮自适应细化
+     * @return 本轮是否新增了采样点
+     */
+    bool refineTile(const TileKey& key);
+
+    /**
+     * @brief 分块抽稀后的绘制点；分块不存在时返回nullptr
+     */
+    const std::vector<Point>* decimated(const TileKey& key);
+
+    /**
+     * @brief 查找分块；不存在时返回nullptr
+     */
+    const Tile* findTile(const TileKey& key) const;
+
+    /**
+     * @brief 缓存超出上限时淘汰最久未用的分块（当前帧可见的分块不淘汰）
+     * @param maxTiles 缓存上限，超出时淘汰到上限的3/4
+     */
+    void evict(std::size_t maxTiles);
+
+    /**
+     * @brief 缓存的分块数
+     */
+    std::size_t tileCount() const { return tiles.size(); }
+
+private:
+    /**
+     * @brief 由两个子分块拼接或从父分块截取初始采样
+     * @return 成功复用返回true
+     */
+    bool seedFromCache(const TileKey& key, Tile& tile) const;
+
+    /**
+     * @brief 按更小的容差重新标记需要细化的区间
+     *
+     * 不做新的求值：用已有的相邻三点估计中间点偏离线性插值的程度。
+     */
+    static void reactivate(Tile& tile, double pixelTolerance);
+
+    /**
+     * @brief 在放弃细化且跨越极点的区间中插入NaN断点
+     *
+     * 极点恰好落在采样点上时会得到NaN，否则细化到上限后区间两端
+     * 仍是一大一小的异号值，不断开就会画出一条竖线。
+     */
+    void insertPoleBreaks(Tile& tile) const;
+
+    /**
+     * @brief 按列做最小/最大值抽稀
+     */
+    static void decimateTile(Tile& tile, double tileSpan);
+
+    CompiledExpression function;      ///< 已编译的表达式
+    std::map<TileKey, Tile> tiles;    ///< 分块缓存
+    double tolerance = 0.0;           ///< 新分块的细化容差
+    double jumpThreshold = 0.0;       ///< 极点判定阈值（可见区域的y跨度）
+    std::uint64_t frame = 0;          ///< 帧序号，用于淘汰
+};
@@ -0,0 +1,132 @@
+/**
+ * @file plotwidget.h
+ * @brief 单变量函数绘图控件声明
+ *
+ * 该文件定义了PlotWidget类，继承自QWidget，绘制含变量x的表达式曲线。
+ * 采样与缓存由FunctionSampler完成，本类负责视口、后台时间片和绘制。
+ */
+
+#ifndef PLOTWIDGET_H
+#define PLOTWIDGET_H
+
+// Qt核心类包含
+#include <QWidget>          // 控件基类
+#include <QString>          // 字符串类
+#include <QPointF>          // 浮点坐标
+#include <QTimer>           // 后台细化定时器
+
+// C++标准库包含
+#include <memory>           // std::unique_ptr
+#include <vector>           // 分块键列表
+
+#include "functionsampler.h" // 分块自适应采样器
+
+class QPainter;
+class QPaintEvent;
+class QMouseEvent;
+class QWheelEvent;
+class QResizeEvent;
+
+/**
+ * @class PlotWidget
+ * @brief 函数绘图控件
+ *
+ * 1. 分块层级由当前缩放决定，每块约占64~128像素（见FunctionSampler）
+ * 2. 视口变化时同步补齐可见分块的粗采样并立即绘制，平移只采样新露出的分块
+ * 3. 细化在零间隔定时器的时间片中进行，每片不超过几毫秒，保证交互流畅
+ * 4. 绘制使用采样器按列抽稀后的点，绘制开销与采样点数无关
+ *
+ * 交互：左键拖动平移，滚轮以光标为中心缩放。
+ */
+class PlotWidget : public QWidget
+{
+    Q_OBJECT  // Qt元对象系统宏，启用信号槽机制和反射
+
+public:
+    /**
+     * @brief 构造函数
+     * @param parent 父控件指针，默认为nullptr
+     */
+    explicit PlotWidget(QWidget *parent = nullptr);
+
+    /**
+     * @brief 设置要绘制的表达式
+     *
+     * 编译失败时清空曲线并在控件内显示错误信息。
+     *
+     * @param expression 含变量x的表达式
+     * @return 编译成功返回true
+     */
+    bool setExpression(const QString &expression);
+
+    /**
+     * @brief 设置可见区域
+     *
+     * 含无穷大/NaN或非递增的范围被忽略；跨度和中心按
+     * FunctionSampler::clampViewRange()夹紧。平移和缩放也经过这里。
+     *
+     * @param xMin x轴最小值
+     * @param xMax x轴最大值
+     * @param yMin y轴最小值
+     * @param yMax y轴最大值
+     */
+    void setViewport(double xMin, double xMax, double yMin, double yMax);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+
+private slots:
+    /**
+     * @brief 后台细化：在一个时间片内对可见分块做自适应细化
+     */
+    void refinePending();
+
+private:
+    /**
+     * @brief 当前缩放对应的分块层级
+     */
+    int currentLevel() const;
+
+    /**
+     * @brief 当前可见的分块键（从左到右）
+     */
+    std::vector<FunctionSampler::TileKey> visibleTiles() const;
+
+    /**
+     * @brief 可见区域变化后调用：补齐缺失分块、安排后台细化并重绘
+     */
+    void viewportChanged();
+
+    /**
+     * @brief 绘制网格、坐标轴和刻度
+     */
+    void drawAxes(QPainter &painter) const;
+
+    /**
+     * @brief 数据坐标转换为控件坐标
+     */
+    QPointF toScreen(double x, double y) const;
+
+    // ==================== 表达式状态 ====================
+    std::unique_ptr<FunctionSampler> sampler; ///< 采样器，无可绘制表达式时为空
+    QString expressionText;        ///< 表达式原文
+    QString errorText;             ///< 编译错误信息
+
+    // ==================== 视口状态 ====================
+    double viewXMin;               ///< 可见区域x最小值
+    double viewXMax;               ///< 可见区域x最大值
+    double viewYMin;               ///< 可见区域y最小值
+    double viewYMax;               ///< 可见区域y最大值
+    bool dragging;                 ///< 是否正在拖动
+    QPointF lastDragPos;           ///< 上一次拖动位置
+
+    // ==================== 后台细化 ====================
+    QTimer refineTimer;            ///< 后台细化定时器（零间隔，空闲时运行）
+};
+
+#endif // PLOTWIDGET_H
@@ -30,8 +30,8 @@ auto main(int argc, char *argv[]) -> int
     // 设置窗口标题，显示计算器名称和使用的Qt版本
     window.setWindowTitle("计算器 - Qt6版");
     
-    // 设置窗口初始大小：宽度500像素，高度300像素
-    window.resize(500, 300);
+    // 设置窗口初始大小：宽度500像素，高度600像素（包含绘图区域）
+    window.resize(500, 600);
     
     // 显示主窗口，使其可见并可交互
     window.show();
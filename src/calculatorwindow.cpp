@@ -3,6 +3,7 @@
 
 #include "calculatorwindow.h"           // 计算器主窗口类声明
 #include "evaluator.h"            // 表达式求值器
+#include "plotwidget.h"           // 函数绘图控件
 #include <QMessageBox>            // 消息弹窗
 #include <QIntValidator>          // 整数输入验证器
 #include <QGridLayout>            // 网格布局
@@ -40,7 +41,8 @@ CalculatorWindow::~CalculatorWindow()
  * 1. 表达式显示区域
  * 2. 数字按钮（0-9）和操作符按钮（+、-、*、/）
  * 3. 括号按钮和功能按钮（清除、等于）
- * 4. 信号槽连接，处理用户交互
+ * 4. 变量x按钮、绘图按钮和函数绘图区域
+ * 5. 信号槽连接，处理用户交互
  */
 void CalculatorWindow::setupUI()
 {
@@ -80,6 +82,8 @@ void CalculatorWindow::setupUI()
     clearButton = new QPushButton("C", centralWidget);
     equalsButton = new QPushButton("=", centralWidget);
     decimalButton = new QPushButton(".", centralWidget);
+    variableButton = new QPushButton("x", centralWidget);
+    plotButton = new QPushButton("绘图", centralWidget);
     
     // 设置按钮字体
     QFont operatorFont("Arial", 12);
@@ -92,6 +96,8 @@ void CalculatorWindow::setupUI()
     clearButton->setFont(operatorFont);
     equalsButton->setFont(operatorFont);
     decimalButton->setFont(operatorFont);
+    variableButton->setFont(operatorFont);
+    plotButton->setFont(operatorFont);
     
     // 连接操作符按钮信号
     connect(addButton, &QPushButton::clicked, this, [this]() { onOperatorClicked("+"); });
@@ -103,6 +109,8 @@ void CalculatorWindow::setupUI()
     connect(clearButton, &QPushButton::clicked, this, &CalculatorWindow::clearExpression);
     connect(equalsButton, &QPushButton::clicked, this, &CalculatorWindow::evaluateExpression);
     connect(decimalButton, &QPushButton::clicked, this, &CalculatorWindow::onDecimalClicked);
+    connect(variableButton, &QPushButton::clicked, this, &CalculatorWindow::onVariableClicked);
+    connect(plotButton, &QPushButton::clicked, this, &CalculatorWindow::plotExpression);
     
     // 布局按钮
     // 第一行：7 8 9 + (
@@ -126,17 +134,25 @@ void CalculatorWindow::setupUI()
     buttonLayout->addWidget(multiplyButton, 2, 3);
     buttonLayout->addWidget(clearButton, 2, 4);
     
-    // 第四行：0 . / =
+    // 第四行：0 . x / =
     buttonLayout->addWidget(digitButtons[0], 3, 0);
     buttonLayout->addWidget(decimalButton, 3, 1);
+    buttonLayout->addWidget(variableButton, 3, 2);
     buttonLayout->addWidget(divideButton, 3, 3);
     buttonLayout->addWidget(equalsButton, 3, 4);
     
+    // 第五行：绘图（横跨整行）
+    buttonLayout->addWidget(plotButton, 4, 0, 1, 5);
+    
     // 将按钮布局添加到主布局
     mainLayout->addLayout(buttonLayout);
     
+    // ==================== 函数绘图区域 ====================
+    plotWidget = new PlotWidget(centralWidget);
+    mainLayout->addWidget(plotWidget, 1);
+    
     // 设置窗口大小
-    resize(400, 300);
+    resize(400, 600);
 }
 
 /**
@@ -189,4 +205,21 @@ void CalculatorWindow::onDecimalClicked()
 {
     QString current = expressionDisplay->text();
     expressionDisplay->setText(current + ".");
+}
+
+void CalculatorWindow::onVariableClicked()
+{
+    QString current = expressionDisplay->text();
+    expressionDisplay->setText(current + "x");
+}
+
+/**
+ * @brief 绘制当前表达式
+ *
+ * 表达式交给PlotWidget编译一次后批量采样；编译错误显示在绘图区域内，
+ * 不弹出对话框。
+ */
+void CalculatorWindow::plotExpression()
+{
+    plotWidget->setExpression(expressionDisplay->text());
 }
\ No newline at end of file
@@ -4,7 +4,9 @@
  */
 
 #include "evaluator.h"
+#include <algorithm>
 #include <cmath>
+#include <limits>
 #include <sstream>
 #include <iostream>
 
@@ -34,6 +36,14 @@ namespace {
         return hasDigit; // 必须至少有一个数字
     }
 
+    // 批量求值的块大小：每个栈槽占一块，保证求值栈常驻L1缓存
+    constexpr size_t kBatchBlock = 256;
+
+    // 单点求值使用栈上数组的最大深度，超出时才分配堆内存
+    constexpr size_t kScalarStackDepth = 32;
+
+    const double kNaN = numeric_limits<double>::quiet_NaN();
+
 }
 
 double ExpressionEvaluator::evaluate(const string& expression) {
@@ -70,6 +80,138 @@ double ExpressionEvaluator::evaluate(const string& expression) {
     }
 }
 
+CompiledExpression ExpressionEvaluator::compile(const string& expression) {
+    CompiledExpression compiled;
+
+    if (expression.empty()) {
+        compiled.program.push_back({CompiledExpression::Instruction::PushConstant, 0.0});
+        compiled.maxDepth = 1;
+        return compiled;
+    }
+
+    try {
+        vector<string> postfix = infixToPostfix(expression, true);
+        size_t depth = 0;
+
+        for (const string& token : postfix) {
+            CompiledExpression::Instruction instr{CompiledExpression::Instruction::PushConstant, 0.0};
+            if (token.length() == 1 && isOperator(token[0])) {
+                if (depth < 2) {
+                    throw invalid_argument("Invalid expression: insufficient operands");
+                }
+                --depth;
+                switch (token[0]) {
+                    case '+': instr.op = CompiledExpression::Instruction::Add; break;
+                    case '-': instr.op = CompiledExpression::Instruction::Subtract; break;
+                    case '*': instr.op = CompiledExpression::Instruction::Multiply; break;
+                    default:  instr.op = CompiledExpression::Instruction::Divide; break;
+                }
+            } else if (token == "x") {
+                instr.op = CompiledExpression::Instruction::PushVariable;
+                compiled.usesVariable = true;
+                ++depth;
+            } else {
+                // 数字
+                instr.value = stod(token);
+                ++depth;
+            }
+            compiled.program.push_back(instr);
+            compiled.maxDepth = max(compiled.maxDepth, depth);
+        }
+
+        if (depth != 1) {
+            throw invalid_argument("Invalid expression: too many operands");
+        }
+
+        return compiled;
+    } catch (const exception& e) {
+        throw invalid_argument(string("Compile error: ") + e.what());
+    }
+}
+
+double CompiledExpression::evaluate(double x) const {
+    // 逐条解释指令；常见深度下求值栈在栈上，不分配堆内存
+    double local[kScalarStackDepth] = {};
+    vector<double> heap;
+    double* stackBase = local;
+    if (maxDepth > kScalarStackDepth) {
+        heap.resize(maxDepth);
+        stackBase = heap.data();
+    }
+
+    size_t top = 0;
+    for (const Instruction& instr : program) {
+        switch (instr.op) {
+            case Instruction::PushConstant:
+                stackBase[top++] = instr.value;
+                break;
+            case Instruction::PushVariable:
+                stackBase[top++] = x;
+                break;
+            default: {
+                const double b = stackBase[--top];
+                double& a = stackBase[top - 1];
+                switch (instr.op) {
+                    case Instruction::Add:      a += b; break;
+                    case Instruction::Subtract: a -= b; break;
+                    case Instruction::Multiply: a *= b; break;
+                    default:                    a = b == 0.0 ? kNaN : a / b; break;
+                }
+                break;
+            }
+        }
+    }
+    return stackBase[0];
+}
+
+void CompiledExpression::evaluateBatch(const double* xs, double* out, size_t count) const {
+    // 求值栈按块组织：第k个栈槽对应 stackBuf[k*kBatchBlock, (k+1)*kBatchBlock)
+    vector<double> stackBuf(maxDepth * kBatchBlock);
+
+    for (size_t base = 0; base < count; base += kBatchBlock) {
+        const size_t n = min(kBatchBlock, count - base);
+        const double* x = xs + base;
+        size_t top = 0; // 栈中块的数量
+
+        for (const Instruction& instr : program) {
+            double* slot = stackBuf.data() + top * kBatchBlock;
+            switch (instr.op) {
+                case Instruction::PushConstant:
+                    for (size_t i = 0; i < n; ++i) slot[i] = instr.value;
+                    ++top;
+                    break;
+                case Instruction::PushVariable:
+                    for (size_t i = 0; i < n; ++i) slot[i] = x[i];
+                    ++top;
+                    break;
+                default: {
+                    double* a = slot - 2 * kBatchBlock;
+                    const double* b = slot - kBatchBlock;
+                    switch (instr.op) {
+                        case Instruction::Add:
+                            for (size_t i = 0; i < n; ++i) a[i] += b[i];
+                            break;
+                        case Instruction::Subtract:
+                            for (size_t i = 0; i < n; ++i) a[i] -= b[i];
+                            break;
+                        case Instruction::Multiply:
+                            for (size_t i = 0; i < n; ++i) a[i] *= b[i];
+                            break;
+                        default:
+                            // 除零在该点无定义，返回NaN而不是抛出异常
+                            for (size_t i = 0; i < n; ++i) a[i] = b[i] == 0.0 ? kNaN : a[i] / b[i];
+                            break;
+                    }
+                    --top;
+                    break;
+                }
+            }
+        }
+
+        copy(stackBuf.data(), stackBuf.data() + n, out + base);
+    }
+}
+
 int ExpressionEvaluator::precedence(char op) {
     switch (op) {
         case '+':
@@ -102,7 +244,7 @@ double ExpressionEvaluator::applyOperator(double a, double b, char op) {
     }
 }
 
-vector<string> ExpressionEvaluator::infixToPostfix(const string& expression) {
+vector<string> ExpressionEvaluator::infixToPostfix(const string& expression, bool allowVariable) {
     stack<char> ops;
     vector<string> output;
     string number;
@@ -132,7 +274,9 @@ vector<string> ExpressionEvaluator::infixToPostfix(const string& expression) {
                 number.clear();
             }
             
-            if (ch == '(') {
+            if (allowVariable && ch == 'x') {
+                output.push_back("x");
+            } else if (ch == '(') {
                 ops.push(ch);
             } else if (ch == ')') {
                 while (!ops.empty() && ops.top() != '(') {
@@ -0,0 +1,422 @@
+/**
+ * @file functionsampler.cpp
+ * @brief 单变量函数的分块自适应采样器实现
+ */
+
+#include "functionsampler.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+using namespace std;
+
+namespace {
+    constexpr double kTilePixels = 128.0;      // 分块的最大屏幕宽度（像素）
+    constexpr int kCoarseSegments = 16;        // 新分块粗采样的区间数
+    constexpr int kMinSegments = 64;           // 细化后每个分块至少的均匀区间数
+    constexpr int kMaxRefinePasses = 10;       // 每个分块每次激活后最多细化轮数
+    constexpr size_t kMaxTileSamples = 16384;  // 每个分块最多采样点数
+    constexpr int kDecimationColumns = 256;    // 抽稀时每个分块划分的列数
+    constexpr double kMaxTileIndex = 0x1p62;   // 分块序号上限，转换为long long不溢出
+
+    // 区间中点相对线性插值的偏差是否超出容差
+    bool needsRefinement(double y0, double ym, double y1, double tolerance) {
+        const bool f0 = isfinite(y0);
+        const bool fm = isfinite(ym);
+        const bool f1 = isfinite(y1);
+        if (!f0 || !fm || !f1) {
+            // 部分有定义：继续细化以定位间断点；全部无定义则不再细化
+            return f0 || fm || f1;
+        }
+        return abs(ym - 0.5 * (y0 + y1)) > tolerance;
+    }
+}
+
+FunctionSampler::FunctionSampler(const CompiledExpression& expression)
+    : function(expression) {
+}
+
+double FunctionSampler::tileWidth(int level) {
+    return ldexp(1.0, level);
+}
+
+long long FunctionSampler::parentIndex(long long index) {
+    return index >= 0 ? index / 2 : -((-index + 1) / 2);
+}
+
+void FunctionSampler::setResolution(double pixelTolerance, double viewHeight) {
+    tolerance = pixelTolerance;
+    jumpThreshold = viewHeight;
+}
+
+int FunctionSampler::levelFor(double unitsPerPixel) {
+    // 先在double上夹紧再转换，0、负数、NaN和无穷大都不会溢出int
+    const double level = floor(log2(unitsPerPixel * kTilePixels));
+    if (!(level >= kMinLevel)) {
+        return kMinLevel;
+    }
+    if (level > kMaxLevel) {
+        return kMaxLevel;
+    }
+    return static_cast<int>(level);
+}
+
+bool FunctionSampler::clampViewRange(double& lo, double& hi) {
+    if (!isfinite(lo) || !isfinite(hi) || !(hi > lo)) {
+        return false;
+    }
+
+    // hi - lo 可能溢出为无穷大，夹紧后仍得到kMaxSpan
+    const double span = clamp(hi - lo, kMinSpan, kMaxSpan);
+    const double center = clamp(0.5 * lo + 0.5 * hi, -kMaxCoordinate, kMaxCoordinate);
+    lo = center - 0.5 * span;
+    hi = center + 0.5 * span;
+    return true;
+}
+
+vector<FunctionSampler::TileKey> FunctionSampler::tilesInRange(int level, double xMin, double xMax) {
+    const double w = tileWidth(level);
+    const double firstIndex = floor(xMin / w);
+    const double lastIndex = floor(xMax / w);
+    if (!isfinite(firstIndex) || !isfinite(lastIndex) || lastIndex < firstIndex
+        || abs(firstIndex) > kMaxTileIndex || abs(lastIndex) > kMaxTileIndex) {
+        return {};
+    }
+    const auto first = static_cast<long long>(firstIndex);
+    const auto last = static_cast<long long>(lastIndex);
+
+    vector<TileKey> keys;
+    keys.reserve(static_cast<size_t>(last - first + 1));
+    for (long long index = first; index <= last; ++index) {
+        keys.emplace_back(level, index);
+    }
+    return keys;
+}
+
+void FunctionSampler::ensureTiles(const vector<TileKey>& keys) {
+    ++frame;
+    vector<TileKey> fresh;
+
+    for (const TileKey& key : keys) {
+        auto it = tiles.find(key);
+        if (it != tiles.end()) {
+            it->second.lastUsed = frame;
+            if (tolerance < it->second.tolerance) {
+                reactivate(it->second, tolerance);
+            }
+            continue;
+        }
+
+        Tile tile;
+        tile.tolerance = tolerance;
+        tile.lastUsed = frame;
+        if (seedFromCache(key, tile)) {
+            tiles.emplace(key, std::move(tile));
+        } else {
+            fresh.push_back(key);
+        }
+    }
+
+    if (fresh.empty()) {
+        return;
+    }
+
+    // 所有新分块的粗采样点汇总为一次批量求值
+    const size_t pointsPerTile = kCoarseSegments + 1;
+    vector<double> xs;
+    xs.reserve(fresh.size() * pointsPerTile);
+    for (const TileKey& key : fresh) {
+        const double w = tileWidth(key.first);
+        const double x0 = static_cast<double>(key.second) * w;
+        for (int i = 0; i <= kCoarseSegments; ++i) {
+            xs.push_back(x0 + w * i / kCoarseSegments);
+        }
+    }
+
+    vector<double> ys(xs.size());
+    function.evaluateBatch(xs.data(), ys.data(), xs.size());
+
+    for (size_t t = 0; t < fresh.size(); ++t) {
+        const auto begin = static_cast<ptrdiff_t>(t * pointsPerTile);
+        const auto end = begin + static_cast<ptrdiff_t>(pointsPerTile);
+
+        Tile tile;
+        tile.xs.assign(xs.begin() + begin, xs.begin() + end);
+        tile.ys.assign(ys.begin() + begin, ys.begin() + end);
+        tile.active.assign(kCoarseSegments, 1);
+        tile.tolerance = tolerance;
+        tile.lastUsed = frame;
+        tiles.emplace(fresh[t], std::move(tile));
+    }
+}
+
+bool FunctionSampler::seedFromCache(const TileKey& key, Tile& tile) const {
+    const int level = key.first;
+    const long long index = key.second;
+
+    // 缩小：两个子分块都已缓存，直接拼接（子分块采样更密）
+    if (level > kMinLevel) {
+        auto left = tiles.find({level - 1, 2 * index});
+        auto right = tiles.find({level - 1, 2 * index + 1});
+        if (left != tiles.end() && right != tiles.end()) {
+            const Tile& l = left->second;
+            const Tile& r = right->second;
+            tile.xs = l.xs;
+            tile.xs.insert(tile.xs.end(), r.xs.begin() + 1, r.xs.end());
+            tile.ys = l.ys;
+            tile.ys.insert(tile.ys.end(), r.ys.begin() + 1, r.ys.end());
+            tile.active = l.active;
+            tile.active.insert(tile.active.end(), r.active.begin(), r.active.end());
+            tile.passes = max(l.passes, r.passes);
+            tile.converged = l.converged && r.converged;
+            return true;
+        }
+    }
+
+    // 放大：父分块已缓存，截取对应的一半作为起点，之后按新容差继续细化
+    if (level < kMaxLevel) {
+        auto parent = tiles.find({level + 1, parentIndex(index)});
+        if (parent != tiles.end()) {
+            const Tile& p = parent->second;
+            const double w = tileWidth(level);
+            const double x0 = static_cast<double>(index) * w;
+            const double x1 = x0 + w;
+            auto first = lower_bound(p.xs.begin(), p.xs.end(), x0);
+            auto last = upper_bound(p.xs.begin(), p.xs.end(), x1);
+            if (last - first < 2 || *first != x0 || *(last - 1) != x1) {
+                return false;
+            }
+
+            const auto offset = first - p.xs.begin();
+            const auto count = last - first;
+            tile.xs.assign(first, last);
+            tile.ys.assign(p.ys.begin() + offset, p.ys.begin() + offset + count);
+            tile.active.assign(static_cast<size_t>(count - 1), 1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * 收集所有待细化区间的中点，一次批量求值后插入。
+ * 区间在以下情况继续细化：宽度仍大于最小均匀密度，
+ * 或中点偏离线性插值超过容差（曲线变化快、有间断）。
+ */
+bool FunctionSampler::refineTile(const TileKey& key) {
+    auto it = tiles.find(key);
+    if (it == tiles.end() || it->second.converged) {
+        return false;
+    }
+    Tile& tile = it->second;
+
+    vector<double> mids;
+    for (size_t i = 0; i < tile.active.size(); ++i) {
+        if (tile.active[i]) {
+            mids.push_back(0.5 * (tile.xs[i] + tile.xs[i + 1]));
+        }
+    }
+    if (mids.empty()) {
+        tile.converged = true;
+        return false;
+    }
+
+    vector<double> midYs(mids.size());
+    function.evaluateBatch(mids.data(), midYs.data(), mids.size());
+
+    const double minSegment = tileWidth(key.first) / kMinSegments;
+    const size_t n = tile.xs.size();
+    vector<double> xs, ys;
+    vector<char> active;
+    xs.reserve(n + mids.size());
+    ys.reserve(n + mids.size());
+    active.reserve(n + mids.size());
+
+    bool anyActive = false;
+    size_t k = 0;
+    for (size_t i = 0; i + 1 < n; ++i) {
+        xs.push_back(tile.xs[i]);
+        ys.push_back(tile.ys[i]);
+        if (!tile.active[i]) {
+            active.push_back(0);
+            continue;
+        }
+
+        const double xm = mids[k];
+        const double ym = midYs[k];
+        ++k;
+        if (!(xm > tile.xs[i] && xm < tile.xs[i + 1])) {
+            // 已达到浮点分辨率，无法再分
+            active.push_back(0);
+            continue;
+        }
+
+        const bool refine = (xm - tile.xs[i]) > minSegment
+            || needsRefinement(tile.ys[i], ym, tile.ys[i + 1], tile.tolerance);
+        xs.push_back(xm);
+        ys.push_back(ym);
+        active.push_back(refine);
+        active.push_back(refine);
+        anyActive = anyActive || refine;
+    }
+    xs.push_back(tile.xs.back());
+    ys.push_back(tile.ys.back());
+
+    tile.xs.swap(xs);
+    tile.ys.swap(ys);
+    tile.active.swap(active);
+    tile.decimatedDirty = true;
+    ++tile.passes;
+    tile.converged = !anyActive || tile.passes >= kMaxRefinePasses
+        || tile.xs.size() >= kMaxTileSamples;
+    if (tile.converged && anyActive) {
+        insertPoleBreaks(tile);
+    }
+    return true;
+}
+
+void FunctionSampler::reactivate(Tile& tile, double pixelTolerance) {
+    tile.tolerance = pixelTolerance;
+
+    bool anyActive = false;
+    for (size_t i = 1; i + 1 < tile.xs.size(); ++i) {
+        const double x0 = tile.xs[i - 1];
+        const double x1 = tile.xs[i + 1];
+        if (!(x1 > x0)) {
+            continue;
+        }
+
+        // 中间点相对两侧邻点连线的偏差，与细化时的中点判据一致
+        const double t = (tile.xs[i] - x0) / (x1 - x0);
+        const double y0 = tile.ys[i - 1];
+        const double y1 = tile.ys[i + 1];
+        const double ym = tile.ys[i];
+        const bool f0 = isfinite(y0);
+        const bool fm = isfinite(ym);
+        const bool f1 = isfinite(y1);
+        const bool refine = (!f0 || !fm || !f1)
+            ? (f0 || fm || f1)
+            : abs(ym - (y0 + t * (y1 - y0))) > pixelTolerance;
+        if (refine) {
+            tile.active[i - 1] = 1;
+            tile.active[i] = 1;
+            anyActive = true;
+        }
+    }
+
+    if (anyActive && tile.xs.size() < kMaxTileSamples) {
+        tile.converged = false;
+        tile.passes = 0;
+    }
+}
+
+void FunctionSampler::insertPoleBreaks(Tile& tile) const {
+    const double nan = numeric_limits<double>::quiet_NaN();
+    const size_t n = tile.xs.size();
+    vector<double> xs, ys;
+    vector<char> active;
+    xs.reserve(n);
+    ys.reserve(n);
+    active.reserve(n);
+
+    for (size_t i = 0; i + 1 < n; ++i) {
+        xs.push_back(tile.xs[i]);
+        ys.push_back(tile.ys[i]);
+        active.push_back(0);
+
+        const double y0 = tile.ys[i];
+        const double y1 = tile.ys[i + 1];
+        if (tile.active[i] && isfinite(y0) && isfinite(y1)
+            && (y0 < 0.0) != (y1 < 0.0) && abs(y1 - y0) > jumpThreshold) {
+            xs.push_back(0.5 * (tile.xs[i] + tile.xs[i + 1]));
+            ys.push_back(nan);
+            active.push_back(0);
+        }
+    }
+    xs.push_back(tile.xs.back());
+    ys.push_back(tile.ys.back());
+
+    tile.xs.swap(xs);
+    tile.ys.swap(ys);
+    tile.active.swap(active);
+}
+
+/**
+ * 每列保留首、尾、最小、最大四个点，折线外形与原始采样一致；
+ * 无定义的点保留为NaN标记，用于断开曲线。
+ */
+void FunctionSampler::decimateTile(Tile& tile, double tileSpan) {
+    const double nan = numeric_limits<double>::quiet_NaN();
+    const double x0 = tile.xs.front();
+    const double columnWidth = tileSpan / kDecimationColumns;
+    const size_t n = tile.xs.size();
+
+    tile.decimated.clear();
+    size_t i = 0;
+    while (i < n) {
+        if (!isfinite(tile.ys[i])) {
+            if (tile.decimated.empty() || !isnan(tile.decimated.back().y)) {
+                tile.decimated.push_back({tile.xs[i], nan});
+            }
+            ++i;
+            continue;
+        }
+
+        const auto column = static_cast<long long>((tile.xs[i] - x0) / columnWidth);
+        size_t indices[4] = {i, i, i, i}; // 首、最小、最大、尾
+        for (++i; i < n && isfinite(tile.ys[i])
+                  && static_cast<long long>((tile.xs[i] - x0) / columnWidth) == column; ++i) {
+            if (tile.ys[i] < tile.ys[indices[1]]) indices[1] = i;
+            if (tile.ys[i] > tile.ys[indices[2]]) indices[2] = i;
+            indices[3] = i;
+        }
+
+        sort(begin(indices), end(indices));
+        auto last = unique(begin(indices), end(indices));
+        for (auto idx = begin(indices); idx != last; ++idx) {
+            tile.decimated.push_back({tile.xs[*idx], tile.ys[*idx]});
+        }
+    }
+
+    tile.decimatedDirty = false;
+}
+
+const vector<FunctionSampler::Point>* FunctionSampler::decimated(const TileKey& key) {
+    auto it = tiles.find(key);
+    if (it == tiles.end()) {
+        return nullptr;
+    }
+    if (it->second.decimatedDirty) {
+        decimateTile(it->second, tileWidth(key.first));
+    }
+    return &it->second.decimated;
+}
+
+const FunctionSampler::Tile* FunctionSampler::findTile(const TileKey& key) const {
+    auto it = tiles.find(key);
+    return it == tiles.end() ? nullptr : &it->second;
+}
+
+void FunctionSampler::evict(size_t maxTiles) {
+    if (tiles.size() <= maxTiles) {
+        return;
+    }
+
+    vector<pair<uint64_t, TileKey>> order;
+    order.reserve(tiles.size());
+    for (const auto& entry : tiles) {
+        order.emplace_back(entry.second.lastUsed, entry.first);
+    }
+    sort(order.begin(), order.end());
+
+    // 淘汰到上限的3/4，避免每帧都触发；当前可见的分块不淘汰
+    const size_t target = maxTiles * 3 / 4;
+    for (const auto& entry : order) {
+        if (tiles.size() <= target || entry.first == frame) {
+            break;
+        }
+        tiles.erase(entry.second);
+    }
+}
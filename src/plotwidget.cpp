@@ -0,0 +1,329 @@
+// plotwidget.cpp: 实现单变量函数绘图控件
+// 包含视口管理、后台细化时间片、曲线绘制以及平移缩放交互
+
+#include "plotwidget.h"           // 绘图控件类声明
+#include <QPainter>               // 绘图
+#include <QPaintEvent>            // 绘制事件
+#include <QMouseEvent>            // 鼠标事件
+#include <QWheelEvent>            // 滚轮事件
+#include <QResizeEvent>           // 尺寸变化事件
+#include <QElapsedTimer>          // 时间片计时
+#include <QPolygonF>              // 折线
+#include <QPen>                   // 画笔
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr size_t kMaxCachedTiles = 256;    // 分块缓存上限
+    constexpr qint64 kWorkBudgetNs = 4000000;  // 每个后台时间片的预算（4ms，留出绘制时间）
+    constexpr double kZoomStep = 1.25;         // 滚轮每格的缩放倍数
+    constexpr double kScreenClamp = 1e5;       // 屏幕坐标裁剪范围，避免极大值传给QPainter
+
+    // 1、2、5序列的网格间距
+    double niceStep(double span) {
+        const double raw = span / 8.0;
+        const double magnitude = std::pow(10.0, std::floor(std::log10(raw)));
+        const double normalized = raw / magnitude;
+        if (normalized < 1.5) return magnitude;
+        if (normalized < 3.5) return 2.0 * magnitude;
+        if (normalized < 7.5) return 5.0 * magnitude;
+        return 10.0 * magnitude;
+    }
+}
+
+/**
+ * @brief PlotWidget类的构造函数
+ * @param parent 父控件指针，默认为nullptr
+ *
+ * 初始可见区域为 [-10, 10] x [-10, 10]，后台细化定时器以零间隔运行，
+ * 即只在事件队列空闲时执行。
+ */
+PlotWidget::PlotWidget(QWidget *parent)
+    : QWidget(parent)
+    , viewXMin(-10.0)
+    , viewXMax(10.0)
+    , viewYMin(-10.0)
+    , viewYMax(10.0)
+    , dragging(false)
+{
+    setMinimumSize(240, 200);
+    setCursor(Qt::OpenHandCursor);
+
+    refineTimer.setInterval(0);
+    connect(&refineTimer, &QTimer::timeout, this, &PlotWidget::refinePending);
+}
+
+bool PlotWidget::setExpression(const QString &expression)
+{
+    refineTimer.stop();
+    sampler.reset();
+    errorText.clear();
+    expressionText = expression.trimmed();
+
+    if (expressionText.isEmpty()) {
+        update();
+        return false;
+    }
+
+    try {
+        // 只编译一次，之后所有采样都走批量求值
+        sampler = std::make_unique<FunctionSampler>(
+            ExpressionEvaluator::compile(expressionText.toStdString()));
+    } catch (const std::exception &e) {
+        errorText = QString("表达式错误: %1").arg(e.what());
+        update();
+        return false;
+    }
+
+    viewportChanged();
+    return true;
+}
+
+void PlotWidget::setViewport(double xMin, double xMax, double yMin, double yMax)
+{
+    if (!FunctionSampler::clampViewRange(xMin, xMax)
+        || !FunctionSampler::clampViewRange(yMin, yMax)) {
+        return;
+    }
+
+    viewXMin = xMin;
+    viewXMax = xMax;
+    viewYMin = yMin;
+    viewYMax = yMax;
+    viewportChanged();
+}
+
+int PlotWidget::currentLevel() const
+{
+    return FunctionSampler::levelFor((viewXMax - viewXMin) / std::max(1, width()));
+}
+
+std::vector<FunctionSampler::TileKey> PlotWidget::visibleTiles() const
+{
+    return FunctionSampler::tilesInRange(currentLevel(), viewXMin, viewXMax);
+}
+
+/**
+ * @brief 可见区域变化后的统一入口
+ *
+ * 平移、缩放、setViewport()和尺寸变化都经过这里：每次按当前像素大小重算容差，
+ * 容差变小时可见分块会被重新激活。缺失分块的初始采样在此同步完成（开销很小），
+ * 保证下一帧即有曲线；细化交给后台定时器。
+ */
+void PlotWidget::viewportChanged()
+{
+    if (sampler) {
+        const double viewHeight = viewYMax - viewYMin;
+        sampler->setResolution(0.5 * viewHeight / std::max(1, height()), viewHeight);
+        sampler->ensureTiles(visibleTiles());
+        sampler->evict(kMaxCachedTiles);
+        if (!refineTimer.isActive()) {
+            refineTimer.start();
+        }
+    }
+    update();
+}
+
+/**
+ * @brief 后台细化时间片
+ *
+ * 对可见分块轮流各做一轮细化，使整条曲线均匀变清晰；
+ * 超出时间预算即返回，把事件循环让给输入和绘制。
+ */
+void PlotWidget::refinePending()
+{
+    if (!sampler) {
+        refineTimer.stop();
+        return;
+    }
+
+    QElapsedTimer clock;
+    clock.start();
+
+    const std::vector<FunctionSampler::TileKey> keys = visibleTiles();
+    bool changed = false;
+    bool pending = true;
+
+    while (pending && clock.nsecsElapsed() < kWorkBudgetNs) {
+        pending = false;
+        for (const FunctionSampler::TileKey &key : keys) {
+            if (sampler->refineTile(key)) {
+                changed = true;
+                const FunctionSampler::Tile *tile = sampler->findTile(key);
+                pending = pending || !tile->converged;
+            }
+            if (clock.nsecsElapsed() >= kWorkBudgetNs) {
+                pending = true;
+                break;
+            }
+        }
+    }
+
+    if (!pending) {
+        refineTimer.stop();
+    }
+    if (changed) {
+        update();
+    }
+}
+
+QPointF PlotWidget::toScreen(double x, double y) const
+{
+    const double px = (x - viewXMin) / (viewXMax - viewXMin) * width();
+    const double py = (viewYMax - y) / (viewYMax - viewYMin) * height();
+    return QPointF(px, std::clamp(py, -kScreenClamp, height() + kScreenClamp));
+}
+
+void PlotWidget::drawAxes(QPainter &painter) const
+{
+    const QColor gridColor(230, 230, 230);
+    const QColor axisColor(120, 120, 120);
+    const QColor labelColor(100, 100, 100);
+
+    // 竖直网格线和x刻度
+    const double xStep = niceStep(viewXMax - viewXMin);
+    const auto xFirst = static_cast<qint64>(std::ceil(viewXMin / xStep));
+    const auto xLast = static_cast<qint64>(std::floor(viewXMax / xStep));
+    for (qint64 k = xFirst; k <= xLast; ++k) {
+        const double x = k * xStep;
+        const double px = toScreen(x, 0.0).x();
+        painter.setPen(k == 0 ? axisColor : gridColor);
+        painter.drawLine(QPointF(px, 0), QPointF(px, height()));
+        painter.setPen(labelColor);
+        painter.drawText(QPointF(px + 2, height() - 4), QString::number(x, 'g', 6));
+    }
+
+    // 水平网格线和y刻度
+    const double yStep = niceStep(viewYMax - viewYMin);
+    const auto yFirst = static_cast<qint64>(std::ceil(viewYMin / yStep));
+    const auto yLast = static_cast<qint64>(std::floor(viewYMax / yStep));
+    for (qint64 k = yFirst; k <= yLast; ++k) {
+        const double y = k * yStep;
+        const double py = toScreen(0.0, y).y();
+        painter.setPen(k == 0 ? axisColor : gridColor);
+        painter.drawLine(QPointF(0, py), QPointF(width(), py));
+        painter.setPen(labelColor);
+        painter.drawText(QPointF(2, py - 2), QString::number(y, 'g', 6));
+    }
+}
+
+void PlotWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().color(QPalette::Base));
+    drawAxes(painter);
+
+    if (!errorText.isEmpty()) {
+        painter.setPen(Qt::red);
+        painter.drawText(rect(), Qt::AlignCenter | Qt::TextWordWrap, errorText);
+        return;
+    }
+    if (!sampler) {
+        painter.setPen(Qt::gray);
+        painter.drawText(rect(), Qt::AlignCenter, "输入含 x 的表达式后点击“绘图”");
+        return;
+    }
+
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(QPen(QColor(0, 90, 200), 1.5));
+
+    // 逐分块拼接折线，遇到NaN或缺失分块时断开
+    QPolygonF polyline;
+    auto flush = [&]() {
+        if (polyline.size() >= 2) {
+            painter.drawPolyline(polyline);
+        }
+        polyline.clear();
+    };
+
+    for (const FunctionSampler::TileKey &key : visibleTiles()) {
+        const std::vector<FunctionSampler::Point> *points = sampler->decimated(key);
+        if (points == nullptr) {
+            flush();
+            continue;
+        }
+        for (const FunctionSampler::Point &point : *points) {
+            if (std::isnan(point.y)) {
+                flush();
+            } else {
+                polyline.append(toScreen(point.x, point.y));
+            }
+        }
+    }
+    flush();
+
+    // 不含x的表达式是一条水平线，在标签中注明
+    QString label = QString("y = %1").arg(expressionText);
+    if (!sampler->expression().dependsOnVariable()) {
+        label += "（常数）";
+    }
+    painter.setPen(Qt::black);
+    painter.drawText(rect().adjusted(8, 6, -8, -6), Qt::AlignLeft | Qt::AlignTop, label);
+}
+
+void PlotWidget::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    viewportChanged();
+}
+
+void PlotWidget::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton) {
+        dragging = true;
+        lastDragPos = event->position();
+        setCursor(Qt::ClosedHandCursor);
+    }
+}
+
+void PlotWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    if (!dragging) {
+        return;
+    }
+
+    // 平移：已缓存的分块保持不变，只有新露出的分块需要采样
+    const QPointF delta = event->position() - lastDragPos;
+    lastDragPos = event->position();
+    const double dx = -delta.x() * (viewXMax - viewXMin) / std::max(1, width());
+    const double dy = delta.y() * (viewYMax - viewYMin) / std::max(1, height());
+    setViewport(viewXMin + dx, viewXMax + dx, viewYMin + dy, viewYMax + dy);
+}
+
+void PlotWidget::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton) {
+        dragging = false;
+        setCursor(Qt::OpenHandCursor);
+    }
+}
+
+void PlotWidget::wheelEvent(QWheelEvent *event)
+{
+    const double steps = event->angleDelta().y() / 120.0;
+    if (steps == 0.0) {
+        return;
+    }
+
+    // 以光标所在的数据点为中心缩放
+    const double factor = std::pow(kZoomStep, -steps);
+    const QPointF pos = event->position();
+    const double anchorX = viewXMin + pos.x() / std::max(1, width()) * (viewXMax - viewXMin);
+    const double anchorY = viewYMax - pos.y() / std::max(1, height()) * (viewYMax - viewYMin);
+    const double spanX = (viewXMax - viewXMin) * factor;
+    const double spanY = (viewYMax - viewYMin) * factor;
+    if (spanX < FunctionSampler::kMinSpan || spanX > FunctionSampler::kMaxSpan
+        || spanY < FunctionSampler::kMinSpan || spanY > FunctionSampler::kMaxSpan) {
+        event->accept();
+        return;
+    }
+
+    setViewport(anchorX - (anchorX - viewXMin) * factor,
+                anchorX + (viewXMax - anchorX) * factor,
+                anchorY - (anchorY - viewYMin) * factor,
+                anchorY + (viewYMax - anchorY) * factor);
+    event->accept();
+}
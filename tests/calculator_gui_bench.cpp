@@ -0,0 +1,436 @@
+/**
+ * @file calculator_gui_bench.cpp
+ * @brief CalculatorWindow 输入延迟基准测试
+ *
+ * 使用QtTest和offscreen平台插件无头运行：按录制的按钮序列全速回放，
+ * 记录每次点击从鼠标事件到受影响控件（显示框，绘图时为绘图控件）重绘完成的耗时，
+ * 按槽函数和表达式长度统计p50/p99/max；另外在绘图控件上模拟拖动平移和滚轮缩放，
+ * 统计每帧（输入事件、一个细化时间片和重绘）的耗时并检查是否满足60fps。
+ * 结果写入JSON文件。
+ *
+ * 环境变量：
+ * - CALCULATOR_BENCH_SESSIONS  会话文件目录（默认为源码中的tests/sessions）
+ * - CALCULATOR_BENCH_OUTPUT    JSON输出路径（默认为当前目录下的calculator_gui_bench.json）
+ */
+
+#include <QtTest>
+#include <QApplication>
+#include <QPushButton>
+#include <QLineEdit>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QHash>
+#include <QMap>
+#include <QMouseEvent>
+#include <QWheelEvent>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "calculatorwindow.h"
+#include "plotwidget.h"
+
+namespace {
+    constexpr int kWarmupRounds = 2;     // 预热轮数（不计入统计）
+    constexpr int kRecordedRounds = 20;  // 录制会话的回放轮数
+    constexpr int kGrowthRounds = 3;     // 长表达式回放轮数
+
+    // 长表达式回放："1+1+...+1=" 中加号的个数
+    const int kGrowthTerms[] = {8, 64, 512, 2048};
+
+    // 统计分桶：点击前表达式长度的上界
+    const int kLengthBuckets[] = {16, 128, 1024, 8192};
+
+    constexpr double kFrameBudgetUs = 1e6 / 60.0;  // 60fps的单帧预算（微秒）
+    constexpr int kPlotWarmupFrames = 20;          // 绘图预热帧数（不计入统计）
+    constexpr int kPanFrames = 240;                // 平移帧数
+    constexpr int kPanStepPixels = 6;              // 每帧拖动的像素数
+    constexpr int kPanLegFrames = 60;              // 每隔多少帧换向
+    constexpr int kZoomFrames = 80;                // 缩放帧数
+    constexpr int kZoomLegFrames = 10;             // 每隔多少帧在放大和缩小之间切换
+
+    // 绘图用的表达式：含极点，细化工作量较大
+    const char *const kPlotExpression = "1/(x-1)+x*x*x/50-x";
+
+    /**
+     * @brief 按钮文本对应的槽函数名
+     */
+    QString slotForButton(const QString &label)
+    {
+        if (label.size() == 1 && label[0].isDigit()) return "onDigitClicked";
+        if (label == ".") return "onDecimalClicked";
+        if (label == "+" || label == "-" || label == "*" || label == "/") return "onOperatorClicked";
+        if (label == "(" || label == ")") return "onParenthesisClicked";
+        if (label == "C") return "clearExpression";
+        if (label == "=") return "evaluateExpression";
+        if (label == "x") return "onVariableClicked";
+        if (label == "绘图") return "plotExpression";
+        return QString();
+    }
+
+    /**
+     * @brief 最近秩法百分位数
+     * @param sorted 已升序排列的样本
+     * @param percent 百分位（0-100]
+     */
+    double percentile(const std::vector<double> &sorted, double percent)
+    {
+        const auto rank = static_cast<size_t>(std::ceil(percent / 100.0 * sorted.size()));
+        return sorted[std::max<size_t>(rank, 1) - 1];
+    }
+
+    QJsonObject summarize(std::vector<double> micros)
+    {
+        std::sort(micros.begin(), micros.end());
+        double total = 0.0;
+        for (double value : micros) {
+            total += value;
+        }
+
+        QJsonObject stats;
+        stats["count"] = static_cast<qint64>(micros.size());
+        stats["mean_us"] = total / micros.size();
+        stats["p50_us"] = percentile(micros, 50.0);
+        stats["p99_us"] = percentile(micros, 99.0);
+        stats["max_us"] = micros.back();
+        return stats;
+    }
+}
+
+/**
+ * @class CalculatorGuiBench
+ * @brief 回放按钮序列并统计输入延迟
+ */
+class CalculatorGuiBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void replayRecordedSessions();
+    void replayGrowingExpressions();
+    void panAndZoomPlot();
+    void cleanupTestCase();
+
+private:
+    /// 一次点击的测量结果
+    struct Sample {
+        QString slot;     ///< 触发的槽函数
+        int length;       ///< 点击前表达式长度
+        double micros;    ///< 点击到受影响控件重绘完成的耗时（微秒）
+    };
+
+    /**
+     * @brief 点击一个按钮并记录延迟
+     * @param label 按钮文本
+     * @param record 是否计入统计（预热时为false）
+     */
+    void click(const QString &label, bool record);
+
+    /**
+     * @brief 清除后回放一个会话
+     */
+    void replay(const QStringList &session, bool record);
+
+    /**
+     * @brief 按钮对应的槽函数会改变的控件，计时包括它的重绘
+     */
+    QWidget *widgetForButton(const QString &label) const;
+
+    /**
+     * @brief 向绘图控件发送一个输入事件并计时一帧
+     *
+     * 一帧包括事件处理（缺失分块的初始采样）、一个后台细化时间片和同步重绘。
+     * @param frames 计入的样本；预热时为nullptr
+     */
+    void plotFrame(QEvent *event, std::vector<double> *frames);
+
+    CalculatorWindow *window = nullptr;
+    QLineEdit *display = nullptr;
+    PlotWidget *plot = nullptr;
+    QHash<QString, QPushButton *> buttons;   ///< 按钮文本 -> 按钮
+    QList<QStringList> sessions;             ///< 录制的会话
+    std::vector<Sample> samples;             ///< 全部测量结果
+    std::vector<double> panFrames;           ///< 平移每帧耗时（微秒）
+    std::vector<double> zoomFrames;          ///< 缩放每帧耗时（微秒）
+    int dismissedDialogs = 0;                ///< 被自动关闭的错误对话框数
+};
+
+void CalculatorGuiBench::initTestCase()
+{
+    QString dir = qEnvironmentVariable("CALCULATOR_BENCH_SESSIONS");
+    if (dir.isEmpty()) {
+        dir = CALCULATOR_BENCH_SESSIONS_DIR;
+    }
+
+    const QStringList files = QDir(dir).entryList({"*.session"}, QDir::Files, QDir::Name);
+    QVERIFY2(!files.isEmpty(), qPrintable("No *.session files in " + dir));
+
+    for (const QString &name : files) {
+        QFile file(QDir(dir).filePath(name));
+        QVERIFY2(file.open(QIODevice::ReadOnly | QIODevice::Text), qPrintable(file.fileName()));
+        QTextStream in(&file);
+        while (!in.atEnd()) {
+            const QString line = in.readLine().trimmed();
+            if (line.isEmpty() || line.startsWith('#')) {
+                continue;
+            }
+            sessions.append(line.split(' ', Qt::SkipEmptyParts));
+        }
+    }
+
+    window = new CalculatorWindow();
+    window->show();
+    QVERIFY(QTest::qWaitForWindowExposed(window));
+
+    display = window->findChild<QLineEdit *>();
+    QVERIFY(display != nullptr);
+    plot = window->findChild<PlotWidget *>();
+    QVERIFY(plot != nullptr);
+    for (QPushButton *button : window->findChildren<QPushButton *>()) {
+        buttons.insert(button->text(), button);
+    }
+
+    // 会话中的每个按钮都必须存在，否则录制文件与界面已不一致
+    for (const QStringList &session : sessions) {
+        for (const QString &label : session) {
+            QVERIFY2(buttons.contains(label) && !slotForButton(label).isEmpty(),
+                     qPrintable("Unknown button in session: " + label));
+        }
+    }
+
+    for (int round = 0; round < kWarmupRounds; ++round) {
+        for (const QStringList &session : sessions) {
+            replay(session, false);
+        }
+    }
+}
+
+QWidget *CalculatorGuiBench::widgetForButton(const QString &label) const
+{
+    if (label == "绘图") {
+        return plot;
+    }
+    return display;
+}
+
+void CalculatorGuiBench::click(const QString &label, bool record)
+{
+    QPushButton *button = buttons.value(label);
+    QWidget *target = widgetForButton(label);
+    const int length = display->text().size();
+
+    // 求值出错会弹出模态对话框；零间隔定时器会在对话框的事件循环中触发并关闭它，
+    // 没有对话框时则在下面的processEvents()中空转一次
+    QTimer::singleShot(0, this, [this]() {
+        if (QWidget *modal = QApplication::activeModalWidget()) {
+            ++dismissedDialogs;
+            modal->close();
+        }
+    });
+
+    QElapsedTimer clock;
+    clock.start();
+    QTest::mouseClick(button, Qt::LeftButton);
+    target->repaint();
+    const qint64 elapsed = clock.nsecsElapsed();
+
+    // 处理点击产生的后续事件（如绘图的后台细化），不计入延迟
+    QCoreApplication::processEvents();
+
+    if (record) {
+        samples.push_back({slotForButton(label), length, elapsed / 1000.0});
+    }
+}
+
+void CalculatorGuiBench::replay(const QStringList &session, bool record)
+{
+    click("C", record);
+    for (const QString &label : session) {
+        click(label, record);
+    }
+}
+
+void CalculatorGuiBench::replayRecordedSessions()
+{
+    for (int round = 0; round < kRecordedRounds; ++round) {
+        for (const QStringList &session : sessions) {
+            replay(session, true);
+        }
+    }
+}
+
+void CalculatorGuiBench::replayGrowingExpressions()
+{
+    for (int round = 0; round < kGrowthRounds; ++round) {
+        for (int terms : kGrowthTerms) {
+            QStringList session;
+            for (int i = 0; i < terms; ++i) {
+                session << "1" << "+";
+            }
+            session << "1" << "=";
+            replay(session, true);
+            QCOMPARE(display->text(), QString::number(terms + 1));
+        }
+    }
+}
+
+void CalculatorGuiBench::plotFrame(QEvent *event, std::vector<double> *frames)
+{
+    QElapsedTimer clock;
+    clock.start();
+    QApplication::sendEvent(plot, event);
+    QCoreApplication::processEvents();
+    plot->repaint();
+    const qint64 elapsed = clock.nsecsElapsed();
+
+    if (frames != nullptr) {
+        frames->push_back(elapsed / 1000.0);
+    }
+}
+
+void CalculatorGuiBench::panAndZoomPlot()
+{
+    QVERIFY(plot->setExpression(kPlotExpression));
+    plot->setViewport(-10.0, 10.0, -10.0, 10.0);
+
+    const QPointF center(plot->width() / 2.0, plot->height() / 2.0);
+    QPointF pos = center;
+    auto move = [&](std::vector<double> *frames, int frame) {
+        // 来回拖动，每段都会露出新的分块
+        const int direction = (frame / kPanLegFrames) % 2 == 0 ? -1 : 1;
+        pos += QPointF(direction * kPanStepPixels, 0.5 * direction);
+        QMouseEvent event(QEvent::MouseMove, pos, plot->mapToGlobal(pos),
+                          Qt::NoButton, Qt::LeftButton, Qt::NoModifier);
+        plotFrame(&event, frames);
+    };
+    auto wheel = [&](std::vector<double> *frames, int frame) {
+        // 先放大后缩小，光标位置随帧变化，使缩放中心不总落在分块边界上
+        const int notch = (frame / kZoomLegFrames) % 2 == 0 ? 120 : -120;
+        const QPointF at(plot->width() * (0.3 + 0.4 * (frame % 7) / 6.0), center.y());
+        QWheelEvent event(at, plot->mapToGlobal(at), QPoint(), QPoint(0, notch),
+                          Qt::NoButton, Qt::NoModifier, Qt::NoScrollPhase, false);
+        plotFrame(&event, frames);
+    };
+
+    QTest::mousePress(plot, Qt::LeftButton, Qt::NoModifier, center.toPoint());
+    for (int frame = 0; frame < kPlotWarmupFrames; ++frame) {
+        move(nullptr, frame);
+    }
+    for (int frame = 0; frame < kPanFrames; ++frame) {
+        move(&panFrames, frame);
+    }
+    QTest::mouseRelease(plot, Qt::LeftButton, Qt::NoModifier, pos.toPoint());
+
+    for (int frame = 0; frame < kPlotWarmupFrames; ++frame) {
+        wheel(nullptr, frame);
+    }
+    for (int frame = 0; frame < kZoomFrames; ++frame) {
+        wheel(&zoomFrames, frame);
+    }
+
+    std::vector<double> sorted = panFrames;
+    sorted.insert(sorted.end(), zoomFrames.begin(), zoomFrames.end());
+    std::sort(sorted.begin(), sorted.end());
+    const double p99 = percentile(sorted, 99.0);
+    QVERIFY2(p99 <= kFrameBudgetUs,
+             qPrintable(QString("Pan/zoom p99 frame time %1 us exceeds %2 us")
+                            .arg(p99, 0, 'f', 0).arg(kFrameBudgetUs, 0, 'f', 0)));
+}
+
+void CalculatorGuiBench::cleanupTestCase()
+{
+    delete window;
+    window = nullptr;
+    QVERIFY(!samples.empty());
+
+    // 按槽函数汇总，以及按槽函数 x 表达式长度分桶汇总
+    QMap<QString, std::vector<double>> bySlot;
+    QMap<QString, QMap<int, std::vector<double>>> byLength;
+    for (const Sample &sample : samples) {
+        bySlot[sample.slot].push_back(sample.micros);
+        int bucket = std::numeric_limits<int>::max(); // 超出最大分桶
+        for (int bound : kLengthBuckets) {
+            if (sample.length <= bound) {
+                bucket = bound;
+                break;
+            }
+        }
+        byLength[sample.slot][bucket].push_back(sample.micros);
+    }
+
+    QJsonObject slotStats;
+    std::vector<double> all;
+    for (auto it = bySlot.cbegin(); it != bySlot.cend(); ++it) {
+        slotStats[it.key()] = summarize(it.value());
+        all.insert(all.end(), it.value().begin(), it.value().end());
+    }
+
+    QJsonObject lengthStats;
+    for (auto it = byLength.cbegin(); it != byLength.cend(); ++it) {
+        QJsonArray buckets;
+        for (auto bucket = it.value().cbegin(); bucket != it.value().cend(); ++bucket) {
+            QJsonObject stats = summarize(bucket.value());
+            if (bucket.key() == std::numeric_limits<int>::max()) {
+                stats["max_length"] = QJsonValue::Null;
+            } else {
+                stats["max_length"] = bucket.key();
+            }
+            buckets.append(stats);
+        }
+        lengthStats[it.key()] = buckets;
+    }
+
+    QJsonObject report;
+    report["benchmark"] = "calculator_gui_bench";
+    report["version"] = CALCULATOR_VERSION;
+    report["build_type"] = CALCULATOR_BUILD_TYPE;
+    report["qt_version"] = qVersion();
+    report["platform"] = QGuiApplication::platformName();
+    report["sessions"] = static_cast<int>(sessions.size());
+    report["dismissed_dialogs"] = dismissedDialogs;
+    report["all"] = summarize(all);
+    report["slots"] = slotStats;
+    report["by_expression_length"] = lengthStats;
+
+    if (!panFrames.empty() && !zoomFrames.empty()) {
+        QJsonObject plotStats;
+        plotStats["expression"] = kPlotExpression;
+        plotStats["budget_us"] = kFrameBudgetUs;
+        plotStats["pan"] = summarize(panFrames);
+        plotStats["zoom"] = summarize(zoomFrames);
+        report["plot_frames"] = plotStats;
+    }
+
+    QString path = qEnvironmentVariable("CALCULATOR_BENCH_OUTPUT");
+    if (path.isEmpty()) {
+        path = "calculator_gui_bench.json";
+    }
+    QFile out(path);
+    QVERIFY2(out.open(QIODevice::WriteOnly | QIODevice::Truncate), qPrintable(path));
+    out.write(QJsonDocument(report).toJson(QJsonDocument::Indented));
+    qInfo("Latency report written to %s", qPrintable(QFileInfo(out).absoluteFilePath()));
+}
+
+int main(int argc, char *argv[])
+{
+    // 无显示环境下运行：未指定平台插件时使用offscreen
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication app(argc, argv);
+    CalculatorGuiBench bench;
+    return QTest::qExec(&bench, argc, argv);
+}
+
+#include "calculator_gui_bench.moc"
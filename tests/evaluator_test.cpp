@@ -7,6 +7,9 @@
 #include "evaluator.h"
 #include <cmath>
 #include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 TEST(ExpressionEvaluatorTest, HandlesEmptyExpression) {
     // 空表达式应返回 0.0
@@ -101,4 +104,94 @@ TEST(ExpressionEvaluatorTest, HandlesFloatingPointPrecision) {
 
     result = ExpressionEvaluator::evaluate("0.1+0.2");
     EXPECT_NEAR(0.3, result, 1e-12);
-}
\ No newline at end of file
+}
+
+TEST(CompiledExpressionTest, EvaluatesVariable) {
+    CompiledExpression f = ExpressionEvaluator::compile("x*x+2*x+1");
+    EXPECT_TRUE(f.dependsOnVariable());
+    EXPECT_DOUBLE_EQ(1.0, f.evaluate(0.0));
+    EXPECT_DOUBLE_EQ(4.0, f.evaluate(1.0));
+    EXPECT_DOUBLE_EQ(0.0, f.evaluate(-1.0));
+    EXPECT_DOUBLE_EQ(9.0, f.evaluate(2.0));
+}
+
+TEST(CompiledExpressionTest, MatchesEvaluatorForConstantExpressions) {
+    CompiledExpression f = ExpressionEvaluator::compile("(2+3)*3+2");
+    EXPECT_FALSE(f.dependsOnVariable());
+    EXPECT_DOUBLE_EQ(ExpressionEvaluator::evaluate("(2+3)*3+2"), f.evaluate(123.0));
+}
+
+TEST(CompiledExpressionTest, BatchMatchesClosedForm) {
+    // 元素个数跨越多个内部块且不是块大小的整数倍；
+    // 减法和除法的操作数顺序、栈槽偏移出错都会使结果偏离解析式
+    CompiledExpression f = ExpressionEvaluator::compile("(x-1)/(x*x+1)*3.5-x/4");
+    std::vector<double> xs(1000);
+    for (size_t i = 0; i < xs.size(); ++i) {
+        xs[i] = -10.0 + 0.02 * static_cast<double>(i);
+    }
+    std::vector<double> ys(xs.size());
+    f.evaluateBatch(xs.data(), ys.data(), xs.size());
+    for (size_t i = 0; i < xs.size(); ++i) {
+        const double x = xs[i];
+        const double expected = (x - 1.0) / (x * x + 1.0) * 3.5 - x / 4.0;
+        EXPECT_NEAR(expected, ys[i], 1e-12);
+        EXPECT_NEAR(expected, f.evaluate(x), 1e-12);
+    }
+
+    // 输入输出可为同一数组
+    f.evaluateBatch(xs.data(), xs.data(), xs.size());
+    EXPECT_EQ(ys, xs);
+}
+
+TEST(CompiledExpressionTest, BatchMatchesEvaluatorWithSubstitution) {
+    // 以不含变量的求值器为参照：把x替换为具体数值后求值
+    const std::string expression = "((x+2)*(x-3)-x)/(x+0.5)";
+    CompiledExpression f = ExpressionEvaluator::compile(expression);
+    const std::vector<double> xs = {0.25, 1.0, 2.5, 4.0, 7.75, 12.0};
+    std::vector<double> ys(xs.size());
+    f.evaluateBatch(xs.data(), ys.data(), xs.size());
+    for (size_t i = 0; i < xs.size(); ++i) {
+        std::string substituted;
+        for (char ch : expression) {
+            substituted += ch == 'x' ? std::to_string(xs[i]) : std::string(1, ch);
+        }
+        EXPECT_DOUBLE_EQ(ExpressionEvaluator::evaluate(substituted), ys[i]);
+    }
+}
+
+TEST(CompiledExpressionTest, HandlesDeepExpressions) {
+    // 求值栈深度超过单点求值的栈上数组时走堆内存
+    std::string expression = "x";
+    for (int i = 0; i < 40; ++i) {
+        expression = "1+(" + expression + ")";
+    }
+    CompiledExpression f = ExpressionEvaluator::compile(expression);
+    EXPECT_DOUBLE_EQ(42.0, f.evaluate(2.0));
+    double x = 2.0;
+    double y = 0.0;
+    f.evaluateBatch(&x, &y, 1);
+    EXPECT_DOUBLE_EQ(42.0, y);
+}
+
+TEST(CompiledExpressionTest, DivisionByZeroYieldsNaN) {
+    CompiledExpression f = ExpressionEvaluator::compile("1/x");
+    EXPECT_TRUE(std::isnan(f.evaluate(0.0)));
+    EXPECT_DOUBLE_EQ(0.5, f.evaluate(2.0));
+}
+
+TEST(CompiledExpressionTest, ThrowsOnInvalidExpression) {
+    EXPECT_THROW(ExpressionEvaluator::compile("x+"), std::invalid_argument);
+    EXPECT_THROW(ExpressionEvaluator::compile("2x"), std::invalid_argument);
+    EXPECT_THROW(ExpressionEvaluator::compile("(x+1"), std::invalid_argument);
+    EXPECT_THROW(ExpressionEvaluator::compile("y+1"), std::invalid_argument);
+}
+
+TEST(CompiledExpressionTest, OnlyCreatedByCompile) {
+    // 默认构造的对象没有指令，求值会越界，因此不允许在外部构造
+    EXPECT_FALSE(std::is_default_constructible<CompiledExpression>::value);
+    EXPECT_TRUE(std::is_copy_constructible<CompiledExpression>::value);
+}
+
+TEST(ExpressionEvaluatorTest, RejectsVariableOutsideCompile) {
+    EXPECT_THROW(ExpressionEvaluator::evaluate("x+1"), std::invalid_argument);
+}
@@ -0,0 +1,405 @@
+/**
+ * @file functionsampler_test.cpp
+ * @brief FunctionSampler 单元测试
+ */
+
+#include <gtest/gtest.h>
+#include "functionsampler.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <vector>
+
+namespace {
+    using TileKey = FunctionSampler::TileKey;
+
+    FunctionSampler makeSampler(const std::string& expression, double tolerance = 0.01,
+                                double viewHeight = 20.0) {
+        FunctionSampler sampler(ExpressionEvaluator::compile(expression));
+        sampler.setResolution(tolerance, viewHeight);
+        return sampler;
+    }
+
+    // 细化到收敛，返回细化轮数
+    int refineUntilConverged(FunctionSampler& sampler, const TileKey& key) {
+        int rounds = 0;
+        while (sampler.refineTile(key)) {
+            ++rounds;
+        }
+        return rounds;
+    }
+}
+
+TEST(FunctionSamplerTest, ParentIndexRoundsTowardNegativeInfinity) {
+    EXPECT_EQ(0, FunctionSampler::parentIndex(0));
+    EXPECT_EQ(0, FunctionSampler::parentIndex(1));
+    EXPECT_EQ(1, FunctionSampler::parentIndex(2));
+    EXPECT_EQ(1, FunctionSampler::parentIndex(3));
+    EXPECT_EQ(-1, FunctionSampler::parentIndex(-1));
+    EXPECT_EQ(-1, FunctionSampler::parentIndex(-2));
+    EXPECT_EQ(-2, FunctionSampler::parentIndex(-3));
+    EXPECT_EQ(-2, FunctionSampler::parentIndex(-4));
+    EXPECT_EQ(-3, FunctionSampler::parentIndex(-5));
+}
+
+TEST(FunctionSamplerTest, TilesCoverRange) {
+    // 层级1的分块宽度为2
+    std::vector<TileKey> keys = FunctionSampler::tilesInRange(1, -3.0, 3.0);
+    ASSERT_EQ(4u, keys.size());
+    EXPECT_EQ(TileKey(1, -2), keys.front());
+    EXPECT_EQ(TileKey(1, 1), keys.back());
+
+    // 每个分块占64~128像素
+    const int level = FunctionSampler::levelFor(20.0 / 800.0);
+    const double pixels = FunctionSampler::tileWidth(level) / (20.0 / 800.0);
+    EXPECT_GT(pixels, 64.0);
+    EXPECT_LE(pixels, 128.0);
+}
+
+TEST(FunctionSamplerTest, HandlesNonFiniteRanges) {
+    const double inf = std::numeric_limits<double>::infinity();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    EXPECT_EQ(FunctionSampler::kMinLevel, FunctionSampler::levelFor(0.0));
+    EXPECT_EQ(FunctionSampler::kMinLevel, FunctionSampler::levelFor(nan));
+    EXPECT_EQ(FunctionSampler::kMaxLevel, FunctionSampler::levelFor(inf));
+    EXPECT_TRUE(FunctionSampler::tilesInRange(0, -inf, 0.0).empty());
+    EXPECT_TRUE(FunctionSampler::tilesInRange(0, 0.0, nan).empty());
+    EXPECT_TRUE(FunctionSampler::tilesInRange(FunctionSampler::kMinLevel, 0.0, 1e300).empty());
+}
+
+TEST(FunctionSamplerTest, ClampsViewRange) {
+    const double inf = std::numeric_limits<double>::infinity();
+    double lo = 1.0, hi = 2.0;
+    EXPECT_FALSE(FunctionSampler::clampViewRange(lo, hi = inf));
+    EXPECT_FALSE(FunctionSampler::clampViewRange(lo = std::nan(""), hi = 2.0));
+    lo = 2.0;
+    EXPECT_FALSE(FunctionSampler::clampViewRange(lo, hi = 1.0));
+    EXPECT_DOUBLE_EQ(2.0, lo);
+
+    // 跨度以中心为准夹紧
+    lo = -1e20;
+    hi = 3e20;
+    ASSERT_TRUE(FunctionSampler::clampViewRange(lo, hi));
+    EXPECT_DOUBLE_EQ(FunctionSampler::kMaxSpan, hi - lo);
+    EXPECT_DOUBLE_EQ(FunctionSampler::kMaxCoordinate, 0.5 * (lo + hi));
+
+    lo = -1.7e308;
+    hi = 1.7e308;
+    ASSERT_TRUE(FunctionSampler::clampViewRange(lo, hi));
+    EXPECT_DOUBLE_EQ(FunctionSampler::kMaxSpan, hi - lo);
+
+    lo = 5.0;
+    hi = 5.0 + 1e-9;
+    ASSERT_TRUE(FunctionSampler::clampViewRange(lo, hi));
+    EXPECT_NEAR(FunctionSampler::kMinSpan, hi - lo, 1e-12);
+    EXPECT_NEAR(5.0 + 0.5e-9, 0.5 * (lo + hi), 1e-12);
+
+    // 普通范围保持不变
+    lo = -10.0;
+    hi = 10.0;
+    ASSERT_TRUE(FunctionSampler::clampViewRange(lo, hi));
+    EXPECT_DOUBLE_EQ(-10.0, lo);
+    EXPECT_DOUBLE_EQ(10.0, hi);
+}
+
+TEST(FunctionSamplerTest, ClampedViewRangeHasBoundedTileCount) {
+    // 夹紧后的任意可见区域，分块数不超过 宽度/64 + 2
+    const double ranges[][2] = {{-1e20, 1e20}, {1e300, 1.5e300}, {-1e300, -1e300 * (1 - 1e-15)}};
+    for (const auto& range : ranges) {
+        for (int width : {1, 240, 4000}) {
+            double lo = range[0], hi = range[1];
+            ASSERT_TRUE(FunctionSampler::clampViewRange(lo, hi));
+            const int level = FunctionSampler::levelFor((hi - lo) / width);
+            const size_t count = FunctionSampler::tilesInRange(level, lo, hi).size();
+            EXPECT_GE(count, 1u);
+            EXPECT_LE(count, static_cast<size_t>(width / 64 + 2)) << lo << " " << hi << " " << width;
+        }
+    }
+}
+
+TEST(FunctionSamplerTest, CoarseSamplesMatchFunction) {
+    FunctionSampler sampler = makeSampler("x*x");
+    sampler.ensureTiles({{0, -1}, {0, 0}});
+
+    const FunctionSampler::Tile* tile = sampler.findTile({0, -1});
+    ASSERT_NE(nullptr, tile);
+    EXPECT_DOUBLE_EQ(-1.0, tile->xs.front());
+    EXPECT_DOUBLE_EQ(0.0, tile->xs.back());
+    for (size_t i = 0; i < tile->xs.size(); ++i) {
+        EXPECT_DOUBLE_EQ(tile->xs[i] * tile->xs[i], tile->ys[i]);
+    }
+    EXPECT_EQ(tile->xs.size() - 1, tile->active.size());
+}
+
+TEST(FunctionSamplerTest, RefinementConvergesWithinTolerance) {
+    const double tolerance = 1e-3;
+    FunctionSampler sampler = makeSampler("x*x*x-2*x", tolerance);
+    const TileKey key(0, 1); // [1, 2]
+    sampler.ensureTiles({key});
+    refineUntilConverged(sampler, key);
+
+    const FunctionSampler::Tile* tile = sampler.findTile(key);
+    ASSERT_NE(nullptr, tile);
+    EXPECT_TRUE(tile->converged);
+    ASSERT_TRUE(std::is_sorted(tile->xs.begin(), tile->xs.end()));
+    // 至少达到最小均匀密度（64个区间）
+    EXPECT_GE(tile->xs.size(), 65u);
+
+    // 每个区间的线性插值与真实值之差不超过容差（中点处偏差最大，留少量余量）
+    for (size_t i = 0; i + 1 < tile->xs.size(); ++i) {
+        const double xm = 0.5 * (tile->xs[i] + tile->xs[i + 1]);
+        const double exact = xm * xm * xm - 2 * xm;
+        EXPECT_NEAR(exact, 0.5 * (tile->ys[i] + tile->ys[i + 1]), 2 * tolerance);
+    }
+}
+
+TEST(FunctionSamplerTest, RefinementIsDenserWhereCurveBends) {
+    // 峰值附近弯曲剧烈，远处接近直线
+    FunctionSampler sampler = makeSampler("1/(x*x+0.01)", 1e-3);
+    const TileKey nearPeak(-1, 0);  // [0, 0.5]
+    const TileKey farAway(-1, 10);  // [5, 5.5]
+    sampler.ensureTiles({nearPeak, farAway});
+    refineUntilConverged(sampler, nearPeak);
+    refineUntilConverged(sampler, farAway);
+
+    EXPECT_GT(sampler.findTile(nearPeak)->xs.size(), 2 * sampler.findTile(farAway)->xs.size());
+}
+
+TEST(FunctionSamplerTest, SmallerToleranceReactivatesVisibleTiles) {
+    // 同一层级内放大：容差变小后已收敛的分块应继续细化
+    FunctionSampler sampler = makeSampler("x*x*x-2*x", 0.1);
+    const TileKey key(0, 1); // [1, 2]
+    sampler.ensureTiles({key});
+    refineUntilConverged(sampler, key);
+    const size_t coarseCount = sampler.findTile(key)->xs.size();
+
+    const double tolerance = 1e-4;
+    sampler.setResolution(tolerance, 20.0);
+    sampler.ensureTiles({key});
+    const FunctionSampler::Tile* tile = sampler.findTile(key);
+    EXPECT_FALSE(tile->converged);
+    EXPECT_DOUBLE_EQ(tolerance, tile->tolerance);
+
+    refineUntilConverged(sampler, key);
+    EXPECT_GT(tile->xs.size(), coarseCount);
+    for (size_t i = 0; i + 1 < tile->xs.size(); ++i) {
+        const double xm = 0.5 * (tile->xs[i] + tile->xs[i + 1]);
+        const double exact = xm * xm * xm - 2 * xm;
+        EXPECT_NEAR(exact, 0.5 * (tile->ys[i] + tile->ys[i + 1]), 2 * tolerance);
+    }
+}
+
+TEST(FunctionSamplerTest, LargerToleranceKeepsTilesConverged) {
+    FunctionSampler sampler = makeSampler("x*x*x-2*x", 1e-3);
+    const TileKey key(0, 1);
+    sampler.ensureTiles({key});
+    refineUntilConverged(sampler, key);
+    const size_t count = sampler.findTile(key)->xs.size();
+
+    sampler.setResolution(1e-2, 20.0);
+    sampler.ensureTiles({key});
+    EXPECT_TRUE(sampler.findTile(key)->converged);
+    EXPECT_FALSE(sampler.refineTile(key));
+    EXPECT_EQ(count, sampler.findTile(key)->xs.size());
+}
+
+TEST(FunctionSamplerTest, MergesCachedChildrenWhenZoomingOut) {
+    FunctionSampler sampler = makeSampler("x*x-x");
+    const TileKey left(0, -2);  // [-2, -1]
+    const TileKey right(0, -1); // [-1, 0]
+    sampler.ensureTiles({left, right});
+    refineUntilConverged(sampler, left);
+    refineUntilConverged(sampler, right);
+    const FunctionSampler::Tile leftTile = *sampler.findTile(left);
+    const FunctionSampler::Tile rightTile = *sampler.findTile(right);
+
+    const TileKey parent(1, -1); // [-2, 0]
+    sampler.ensureTiles({parent});
+    const FunctionSampler::Tile* merged = sampler.findTile(parent);
+    ASSERT_NE(nullptr, merged);
+
+    std::vector<double> expected = leftTile.xs;
+    expected.insert(expected.end(), rightTile.xs.begin() + 1, rightTile.xs.end());
+    EXPECT_EQ(expected, merged->xs);
+    EXPECT_EQ(merged->xs.size(), merged->ys.size());
+    EXPECT_EQ(merged->xs.size() - 1, merged->active.size());
+    EXPECT_TRUE(merged->converged);
+}
+
+TEST(FunctionSamplerTest, SlicesCachedParentWhenZoomingIn) {
+    FunctionSampler sampler = makeSampler("x*x-x");
+    const TileKey parent(1, -1); // [-2, 0]
+    sampler.ensureTiles({parent});
+    sampler.refineTile(parent);
+    const FunctionSampler::Tile parentTile = *sampler.findTile(parent);
+
+    const TileKey child(0, -1); // [-1, 0]，负序号的父分块为 (1, -1)
+    sampler.ensureTiles({child});
+    const FunctionSampler::Tile* sliced = sampler.findTile(child);
+    ASSERT_NE(nullptr, sliced);
+    EXPECT_DOUBLE_EQ(-1.0, sliced->xs.front());
+    EXPECT_DOUBLE_EQ(0.0, sliced->xs.back());
+
+    // 截取的点与父分块中的点完全相同，没有重新采样
+    for (size_t i = 0; i < sliced->xs.size(); ++i) {
+        auto it = std::find(parentTile.xs.begin(), parentTile.xs.end(), sliced->xs[i]);
+        ASSERT_NE(parentTile.xs.end(), it);
+        EXPECT_EQ(parentTile.ys[it - parentTile.xs.begin()], sliced->ys[i]);
+    }
+    EXPECT_FALSE(sliced->converged);
+}
+
+TEST(FunctionSamplerTest, DecimationBreaksAtUndefinedPoints) {
+    // 分块 [0, 2] 的粗采样点包含 x=1，此处除零为NaN
+    FunctionSampler sampler = makeSampler("1/(x-1)");
+    const TileKey key(1, 0);
+    sampler.ensureTiles({key});
+    refineUntilConverged(sampler, key);
+
+    const std::vector<FunctionSampler::Point>* points = sampler.decimated(key);
+    ASSERT_NE(nullptr, points);
+    ASSERT_FALSE(points->empty());
+    auto nanPoint = std::find_if(points->begin(), points->end(),
+                                 [](const FunctionSampler::Point& p) { return std::isnan(p.y); });
+    ASSERT_NE(points->end(), nanPoint);
+    EXPECT_DOUBLE_EQ(1.0, nanPoint->x);
+
+    // 断点两侧分别为负、正分支
+    EXPECT_LT((nanPoint - 1)->y, 0.0);
+    EXPECT_GT((nanPoint + 1)->y, 0.0);
+}
+
+TEST(FunctionSamplerTest, BreaksAtPoleBetweenSamples) {
+    // 极点 x=0.3 不是二进制小数，永远不会恰好落在采样点上
+    FunctionSampler sampler = makeSampler("1/(x-0.3)");
+    const TileKey key(0, 0); // [0, 1]
+    sampler.ensureTiles({key});
+    refineUntilConverged(sampler, key);
+
+    const std::vector<FunctionSampler::Point>* points = sampler.decimated(key);
+    ASSERT_NE(nullptr, points);
+    auto nanPoint = std::find_if(points->begin(), points->end(),
+                                 [](const FunctionSampler::Point& p) { return std::isnan(p.y); });
+    ASSERT_NE(points->end(), nanPoint);
+    EXPECT_NEAR(0.3, nanPoint->x, 1e-3);
+
+    // 相邻的有定义点之间不再有跨越可见高度的异号跳变
+    for (size_t i = 0; i + 1 < points->size(); ++i) {
+        const double y0 = (*points)[i].y;
+        const double y1 = (*points)[i + 1].y;
+        if (std::isfinite(y0) && std::isfinite(y1)) {
+            EXPECT_FALSE((y0 < 0.0) != (y1 < 0.0) && std::abs(y1 - y0) > 20.0)
+                << "jump at x=" << (*points)[i].x;
+        }
+    }
+}
+
+TEST(FunctionSamplerTest, DoesNotBreakSteepContinuousCurve) {
+    // 陡峭但连续的直线穿过0，细化很快收敛，不应被当成极点
+    FunctionSampler sampler = makeSampler("(x-0.3)*1000");
+    const TileKey key(0, 0);
+    sampler.ensureTiles({key});
+    refineUntilConverged(sampler, key);
+
+    const std::vector<FunctionSampler::Point>* points = sampler.decimated(key);
+    ASSERT_NE(nullptr, points);
+    for (const FunctionSampler::Point& point : *points) {
+        EXPECT_FALSE(std::isnan(point.y));
+    }
+}
+
+TEST(FunctionSamplerTest, DecimationBoundsPointCount) {
+    FunctionSampler sampler = makeSampler("1/(x*x+0.0001)", 1e-6);
+    const TileKey key(0, 0);
+    sampler.ensureTiles({key});
+    refineUntilConverged(sampler, key);
+
+    const size_t samples = sampler.findTile(key)->xs.size();
+    const size_t drawn = sampler.decimated(key)->size();
+    EXPECT_LE(drawn, 4u * 256u);
+    EXPECT_LE(drawn, samples);
+}
+
+TEST(FunctionSamplerTest, EvictionKeepsVisibleTiles) {
+    FunctionSampler sampler = makeSampler("x");
+    for (long long i = 0; i < 40; ++i) {
+        sampler.ensureTiles({{0, i}});
+    }
+    ASSERT_EQ(40u, sampler.tileCount());
+
+    // 当前帧可见的分块数超过上限时一个也不淘汰
+    std::vector<TileKey> visible;
+    for (long long i = 100; i < 120; ++i) {
+        visible.emplace_back(0, i);
+    }
+    sampler.ensureTiles(visible);
+    sampler.evict(16);
+    for (const TileKey& key : visible) {
+        EXPECT_NE(nullptr, sampler.findTile(key));
+    }
+    EXPECT_EQ(visible.size(), sampler.tileCount());
+
+    // 不可见的分块按最近使用顺序淘汰到上限的3/4
+    sampler.ensureTiles({{0, 200}});
+    sampler.evict(16);
+    EXPECT_EQ(12u, sampler.tileCount());
+    EXPECT_NE(nullptr, sampler.findTile({0, 200}));
+    EXPECT_NE(nullptr, sampler.findTile({0, 119}));
+    EXPECT_EQ(nullptr, sampler.findTile({0, 100}));
+}
+
+TEST(FunctionSamplerTest, PanSamplesOnlyNewlyExposedTiles) {
+    // 800像素宽、跨度20的视口，每帧拖动4像素
+    const double unitsPerPixel = 20.0 / 800.0;
+    const int level = FunctionSampler::levelFor(unitsPerPixel);
+    double xMin = -10.0, xMax = 10.0;
+    FunctionSampler sampler = makeSampler("x*x*x/50-x");
+
+    std::vector<TileKey> keys = FunctionSampler::tilesInRange(level, xMin, xMax);
+    sampler.ensureTiles(keys);
+    const size_t coarseCount = sampler.findTile(keys.front())->xs.size();
+    for (const TileKey& key : keys) {
+        refineUntilConverged(sampler, key);
+    }
+
+    size_t totalExposed = 0;
+    for (int frame = 0; frame < 100; ++frame) {
+        std::map<TileKey, size_t> cached;
+        for (const TileKey& key : keys) {
+            cached[key] = sampler.findTile(key)->xs.size();
+        }
+        const size_t tileCount = sampler.tileCount();
+
+        xMin += 4.0 * unitsPerPixel;
+        xMax += 4.0 * unitsPerPixel;
+        keys = FunctionSampler::tilesInRange(level, xMin, xMax);
+        sampler.ensureTiles(keys);
+
+        // 已缓存的分块不重新采样；新露出的分块只做一次粗采样
+        size_t exposed = 0;
+        for (const TileKey& key : keys) {
+            const FunctionSampler::Tile* tile = sampler.findTile(key);
+            ASSERT_NE(nullptr, tile);
+            auto it = cached.find(key);
+            if (it != cached.end()) {
+                EXPECT_EQ(it->second, tile->xs.size());
+                EXPECT_TRUE(tile->converged);
+            } else {
+                ++exposed;
+                EXPECT_EQ(coarseCount, tile->xs.size());
+                EXPECT_EQ(0, tile->passes);
+            }
+        }
+        EXPECT_LE(exposed, 1u);
+        EXPECT_EQ(tileCount + exposed, sampler.tileCount());
+        totalExposed += exposed;
+
+        // 帧间的后台细化
+        for (const TileKey& key : keys) {
+            refineUntilConverged(sampler, key);
+        }
+    }
+    // 共拖动400像素，分块宽64~128像素
+    EXPECT_GE(totalExposed, 3u);
+}